@@ -0,0 +1,629 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Chunked, compressed archive of the simulation history.
+ *
+ * Every step_interval-th step is cut into chunk_size x chunk_size tiles.
+ * A tile stores a and b quantized to 16 bits. Keyframe tiles are delta
+ * coded along the row, all others against the same tile of the previous
+ * stored step. Deltas are written as zigzag varints with runs of zeros
+ * collapsed. An index at the end of the file maps (step, chunk) to a byte
+ * range so a region can be read without decoding the rest of the file.
+ *
+ * File layout (little endian):
+ *   header  "RDAR" version width height chunk_size step_interval
+ *           keyframe_interval
+ *   tiles   encoded tiles, in the order the workers finished them
+ *   index   entry_count x (step chunk keyframe offset size)
+ *   footer  index_offset entry_count "RDIX"
+ */
+
+const uint32_t ARCHIVE_VERSION = 1;
+const size_t ARCHIVE_HEADER_SIZE = 28;
+const size_t ARCHIVE_ENTRY_SIZE = 28;
+const size_t ARCHIVE_FOOTER_SIZE = 20;
+// Largest width, height or chunk size a reader accepts
+const uint32_t ARCHIVE_MAX_SIDE = 1 << 20;
+
+struct ArchiveEntry {
+  int64_t step;
+  uint32_t chunk;
+  uint32_t keyframe;
+  uint64_t offset;
+  uint32_t size;
+};
+
+struct ArchiveLayout {
+  int width;
+  int height;
+  int chunk_size;
+
+  int chunks_x() const { return (width + chunk_size - 1) / chunk_size; }
+  int chunks_y() const { return (height + chunk_size - 1) / chunk_size; }
+  int chunk_count() const { return chunks_x() * chunks_y(); }
+
+  // Tiles on the right and bottom edge are clipped to the field
+  void chunk_rect(int chunk, int &x0, int &y0, int &w, int &h) const {
+    x0 = (chunk % chunks_x()) * chunk_size;
+    y0 = (chunk / chunks_x()) * chunk_size;
+    w = std::min(chunk_size, width - x0);
+    h = std::min(chunk_size, height - y0);
+  }
+};
+
+inline uint16_t archive_quantize(double v) {
+  v = std::max(0.0, std::min(1.0, v));
+  return static_cast<uint16_t>(std::lround(v * 65535.0));
+}
+
+inline double archive_dequantize(uint16_t q) { return q / 65535.0; }
+
+inline void archive_put_u32(std::vector<uint8_t> &out, uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+inline void archive_put_u64(std::vector<uint8_t> &out, uint64_t v) {
+  for (int i = 0; i < 8; ++i)
+    out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+inline uint32_t archive_get_u32(const uint8_t *p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i)
+    v |= static_cast<uint32_t>(p[i]) << (8 * i);
+  return v;
+}
+
+inline uint64_t archive_get_u64(const uint8_t *p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i)
+    v |= static_cast<uint64_t>(p[i]) << (8 * i);
+  return v;
+}
+
+inline void archive_put_varint(std::vector<uint8_t> &out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+inline bool archive_get_varint(const uint8_t *&p, const uint8_t *end,
+                               uint64_t &v) {
+  v = 0;
+  for (int shift = 0; shift < 64 && p < end; shift += 7) {
+    uint8_t byte = *p++;
+    v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+// Predicts sample i from base (previous stored step) if there is one,
+// otherwise from the sample before it in the same plane
+inline int32_t archive_predict(const uint16_t *cur, const uint16_t *base,
+                               size_t i) {
+  if (base)
+    return base[i];
+  return i ? cur[i - 1] : 0;
+}
+
+inline void archive_encode_plane(const uint16_t *cur, const uint16_t *base,
+                                 size_t n, std::vector<uint8_t> &out) {
+  size_t i = 0;
+  while (i < n) {
+    int32_t d = static_cast<int32_t>(cur[i]) - archive_predict(cur, base, i);
+    uint32_t z = (static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31);
+    archive_put_varint(out, z);
+    ++i;
+    if (z == 0) {
+      uint64_t run = 0;
+      while (i < n && cur[i] == archive_predict(cur, base, i)) {
+        ++run;
+        ++i;
+      }
+      archive_put_varint(out, run);
+    }
+  }
+}
+
+inline bool archive_decode_plane(const uint8_t *&p, const uint8_t *end,
+                                 const uint16_t *base, size_t n,
+                                 uint16_t *cur) {
+  size_t i = 0;
+  while (i < n) {
+    uint64_t z;
+    if (!archive_get_varint(p, end, z))
+      return false;
+    int32_t d = static_cast<int32_t>(z >> 1) ^ -static_cast<int32_t>(z & 1);
+    cur[i] = static_cast<uint16_t>(archive_predict(cur, base, i) + d);
+    ++i;
+    if (z == 0) {
+      uint64_t run;
+      if (!archive_get_varint(p, end, run) || run > n - i)
+        return false;
+      for (; run > 0; --run, ++i)
+        cur[i] = static_cast<uint16_t>(archive_predict(cur, base, i));
+    }
+  }
+  return true;
+}
+
+// A tile is stored as its a plane followed by its b plane
+inline void archive_encode_tile(const std::vector<uint16_t> &q,
+                                const uint16_t *base,
+                                std::vector<uint8_t> &out) {
+  size_t n = q.size() / 2;
+  archive_encode_plane(q.data(), base, n, out);
+  archive_encode_plane(q.data() + n, base ? base + n : nullptr, n, out);
+}
+
+inline bool archive_decode_tile(const std::vector<uint8_t> &blob,
+                                const uint16_t *base,
+                                std::vector<uint16_t> &q) {
+  const uint8_t *p = blob.data();
+  const uint8_t *end = p + blob.size();
+  size_t n = q.size() / 2;
+  return archive_decode_plane(p, end, base, n, q.data()) &&
+         archive_decode_plane(p, end, base ? base + n : nullptr, n,
+                              q.data() + n) &&
+         p == end;
+}
+
+template <typename CellT>
+void archive_quantize_tile(const std::vector<CellT> &arr,
+                           const ArchiveLayout &layout, int chunk,
+                           std::vector<uint16_t> &q) {
+  int x0, y0, w, h;
+  layout.chunk_rect(chunk, x0, y0, w, h);
+  size_t n = static_cast<size_t>(w) * h;
+  q.resize(2 * n);
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      const CellT &c = arr[(y0 + y) * layout.width + x0 + x];
+      q[y * w + x] = archive_quantize(c.a);
+      q[n + y * w + x] = archive_quantize(c.b);
+    }
+  }
+}
+
+/*
+ * Writes the archive from a pool of background threads. submit() only
+ * copies the field; quantizing, encoding and writing happen on the
+ * workers. Steps must be submitted in increasing order. At most
+ * max_pending snapshots are in flight, after that submit() blocks so a
+ * slow disk cannot eat all memory. Non-positive sizes or intervals are
+ * rejected like a failed open: is_open() stays false and submit() is a
+ * no-op.
+ */
+template <typename CellT> class ArchiveWriter {
+public:
+  ArchiveWriter(const std::string &path, int width, int height,
+                int step_interval = 10, int chunk_size = 64,
+                int keyframe_interval = 16, int num_threads = 0,
+                int max_pending = 4)
+      : layout{width, height, chunk_size}, step_interval(step_interval),
+        keyframe_interval(keyframe_interval), max_pending(max_pending) {
+    // Same limits the reader enforces; the file is left untouched
+    if (width <= 0 || height <= 0 || chunk_size <= 0 ||
+        width > static_cast<int>(ARCHIVE_MAX_SIDE) ||
+        height > static_cast<int>(ARCHIVE_MAX_SIDE) ||
+        chunk_size > static_cast<int>(ARCHIVE_MAX_SIDE) ||
+        step_interval <= 0 || keyframe_interval <= 0 || max_pending <= 0) {
+      std::cerr << "Invalid archive parameters for " << path << std::endl;
+      return;
+    }
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open archive " << path << std::endl;
+      return;
+    }
+    std::vector<uint8_t> header = {'R', 'D', 'A', 'R'};
+    archive_put_u32(header, ARCHIVE_VERSION);
+    archive_put_u32(header, width);
+    archive_put_u32(header, height);
+    archive_put_u32(header, chunk_size);
+    archive_put_u32(header, step_interval);
+    archive_put_u32(header, keyframe_interval);
+    file.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file_end = header.size();
+
+    if (num_threads <= 0)
+      num_threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    for (int i = 0; i < num_threads; ++i)
+      workers.emplace_back(&ArchiveWriter::worker, this);
+  }
+
+  ~ArchiveWriter() { finish(); }
+
+  ArchiveWriter(const ArchiveWriter &) = delete;
+  ArchiveWriter &operator=(const ArchiveWriter &) = delete;
+
+  bool is_open() const { return file.is_open(); }
+
+  // Queues arr for archiving if step falls on the step interval
+  void submit(int64_t step, const std::vector<CellT> &arr) {
+    if (!is_open() || finished || step % step_interval != 0)
+      return;
+    auto cur = std::make_shared<const std::vector<CellT>>(arr);
+    bool keyframe = stored % keyframe_interval == 0;
+    auto prev = keyframe ? nullptr : last;
+    last = cur;
+    ++stored;
+
+    std::unique_lock<std::mutex> lock(job_mutex);
+    done_cv.wait(lock, [&] { return pending_frames < max_pending; });
+    ++pending_frames;
+    auto remaining = std::make_shared<std::atomic<int>>(layout.chunk_count());
+    for (int chunk = 0; chunk < layout.chunk_count(); ++chunk) {
+      jobs.push_back([=, this] {
+        encode(cur, prev, step, chunk, keyframe, remaining);
+      });
+    }
+    job_cv.notify_all();
+  }
+
+  // Drains the queue, writes the index and closes the file
+  bool finish() {
+    if (finished)
+      return !failed;
+    finished = true;
+    {
+      std::lock_guard<std::mutex> lock(job_mutex);
+      stopping = true;
+    }
+    job_cv.notify_all();
+    for (auto &t : workers)
+      t.join();
+    workers.clear();
+    if (!file.is_open())
+      return false;
+
+    std::sort(index.begin(), index.end(),
+              [](const ArchiveEntry &l, const ArchiveEntry &r) {
+                return l.step != r.step ? l.step < r.step : l.chunk < r.chunk;
+              });
+    std::vector<uint8_t> tail;
+    for (const auto &e : index) {
+      archive_put_u64(tail, static_cast<uint64_t>(e.step));
+      archive_put_u32(tail, e.chunk);
+      archive_put_u32(tail, e.keyframe);
+      archive_put_u64(tail, e.offset);
+      archive_put_u32(tail, e.size);
+    }
+    archive_put_u64(tail, file_end);
+    archive_put_u64(tail, index.size());
+    tail.insert(tail.end(), {'R', 'D', 'I', 'X'});
+    file.write(reinterpret_cast<const char *>(tail.data()), tail.size());
+    file.close();
+    if (failed || file.fail()) {
+      failed = true;
+      std::cerr << "Failed to write archive" << std::endl;
+    }
+    return !failed;
+  }
+
+private:
+  void worker() {
+    for (;;) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(job_mutex);
+        job_cv.wait(lock, [&] { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+          return;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+  void encode(std::shared_ptr<const std::vector<CellT>> cur,
+              std::shared_ptr<const std::vector<CellT>> prev, int64_t step,
+              int chunk, bool keyframe,
+              std::shared_ptr<std::atomic<int>> remaining) {
+    std::vector<uint16_t> q, base;
+    archive_quantize_tile(*cur, layout, chunk, q);
+    if (prev)
+      archive_quantize_tile(*prev, layout, chunk, base);
+    std::vector<uint8_t> blob;
+    archive_encode_tile(q, prev ? base.data() : nullptr, blob);
+
+    {
+      std::lock_guard<std::mutex> lock(file_mutex);
+      index.push_back({step, static_cast<uint32_t>(chunk), keyframe,
+                       file_end, static_cast<uint32_t>(blob.size())});
+      file.write(reinterpret_cast<const char *>(blob.data()), blob.size());
+      file_end += blob.size();
+      if (file.fail())
+        failed = true;
+    }
+
+    if (--*remaining == 0) {
+      std::lock_guard<std::mutex> lock(job_mutex);
+      --pending_frames;
+      done_cv.notify_all();
+    }
+  }
+
+  ArchiveLayout layout;
+  int step_interval;
+  int keyframe_interval;
+  int max_pending;
+
+  // Only touched by the submitting thread
+  std::shared_ptr<const std::vector<CellT>> last;
+  int64_t stored = 0;
+  bool finished = false;
+
+  std::mutex file_mutex;
+  std::ofstream file;
+  uint64_t file_end = 0;
+  std::vector<ArchiveEntry> index;
+  bool failed = false;
+
+  std::mutex job_mutex;
+  std::condition_variable job_cv;
+  std::condition_variable done_cv;
+  std::deque<std::function<void()>> jobs;
+  int pending_frames = 0;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+};
+
+/*
+ * Random access and streaming over an archive. read_region() decodes only
+ * the tiles overlapping the region, starting from their last keyframe.
+ * stream_region() walks a region through time and decodes each tile once
+ * per stored step.
+ */
+class ArchiveReader {
+public:
+  bool open(const std::string &path) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open archive " << path << std::endl;
+      return false;
+    }
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    uint8_t footer[ARCHIVE_FOOTER_SIZE];
+    file.seekg(0, std::ios::end);
+    uint64_t size = file.tellg();
+    if (size < ARCHIVE_HEADER_SIZE + ARCHIVE_FOOTER_SIZE ||
+        !read_at(0, header, sizeof(header)) ||
+        !read_at(size - sizeof(footer), footer, sizeof(footer)) ||
+        std::string(header, header + 4) != "RDAR" ||
+        std::string(footer + 16, footer + 20) != "RDIX" ||
+        archive_get_u32(header + 4) != ARCHIVE_VERSION) {
+      std::cerr << "Not a reaction-diffusion archive: " << path << std::endl;
+      file.close();
+      return false;
+    }
+    uint32_t width = archive_get_u32(header + 8);
+    uint32_t height = archive_get_u32(header + 12);
+    uint32_t chunk_size = archive_get_u32(header + 16);
+    if (width == 0 || height == 0 || chunk_size == 0 ||
+        width > ARCHIVE_MAX_SIDE || height > ARCHIVE_MAX_SIDE ||
+        chunk_size > ARCHIVE_MAX_SIDE) {
+      std::cerr << "Corrupt archive header: " << path << std::endl;
+      file.close();
+      return false;
+    }
+    layout = {static_cast<int>(width), static_cast<int>(height),
+              static_cast<int>(chunk_size)};
+    interval = archive_get_u32(header + 20);
+
+    // Everything below comes from the file, so it is bounded by the file
+    // size before anything is allocated or indexed with it
+    index_offset = archive_get_u64(footer);
+    uint64_t count = archive_get_u64(footer + 8);
+    uint64_t chunks = static_cast<uint64_t>(layout.chunks_x()) *
+                      static_cast<uint64_t>(layout.chunks_y());
+    uint64_t body = size - ARCHIVE_HEADER_SIZE - ARCHIVE_FOOTER_SIZE;
+    if (count > body / ARCHIVE_ENTRY_SIZE || (count > 0 && chunks > count) ||
+        index_offset < ARCHIVE_HEADER_SIZE ||
+        index_offset + count * ARCHIVE_ENTRY_SIZE + ARCHIVE_FOOTER_SIZE !=
+            size) {
+      return corrupt_index(path);
+    }
+    std::vector<uint8_t> raw(count * ARCHIVE_ENTRY_SIZE);
+    if (!read_at(index_offset, raw.data(), raw.size()))
+      return corrupt_index(path);
+
+    // An archive without entries has no tiles to look up
+    by_chunk.assign(count > 0 ? chunks : 0, {});
+    steps_.clear();
+    for (uint64_t i = 0; i < count; ++i) {
+      const uint8_t *p = raw.data() + i * ARCHIVE_ENTRY_SIZE;
+      ArchiveEntry e{static_cast<int64_t>(archive_get_u64(p)),
+                     archive_get_u32(p + 8), archive_get_u32(p + 12),
+                     archive_get_u64(p + 16), archive_get_u32(p + 24)};
+      // The writer sorts the index by (step, chunk)
+      if (e.chunk >= by_chunk.size() ||
+          (!steps_.empty() && e.step < steps_.back()) ||
+          (!by_chunk[e.chunk].empty() &&
+           by_chunk[e.chunk].back().step >= e.step))
+        return corrupt_index(path);
+      by_chunk[e.chunk].push_back(e);
+      if (steps_.empty() || steps_.back() != e.step)
+        steps_.push_back(e.step);
+    }
+    return true;
+  }
+
+  int width() const { return layout.width; }
+  int height() const { return layout.height; }
+  int step_interval() const { return interval; }
+
+  // Stored steps in increasing order
+  const std::vector<int64_t> &steps() const { return steps_; }
+
+  template <typename CellT>
+  bool read_region(int64_t step, int x0, int y0, int w, int h,
+                   std::vector<CellT> &out) {
+    if (!valid_region(x0, y0, w, h))
+      return false;
+    out.resize(static_cast<size_t>(w) * h);
+    std::vector<uint16_t> q;
+    for (int chunk : chunks_in(x0, y0, w, h)) {
+      size_t pos;
+      if (!find(chunk, step, pos) || !decode_at(chunk, pos, q))
+        return false;
+      blit(chunk, q, x0, y0, w, h, out);
+    }
+    return true;
+  }
+
+  // Calls fn(step, region) for every stored step in [first, last]
+  template <typename CellT, typename Fn>
+  bool stream_region(int x0, int y0, int w, int h, int64_t first,
+                     int64_t last, Fn fn) {
+    if (!valid_region(x0, y0, w, h))
+      return false;
+    std::vector<int> chunks = chunks_in(x0, y0, w, h);
+    std::vector<std::vector<uint16_t>> q(chunks.size());
+    std::vector<size_t> decoded(chunks.size(), SIZE_MAX);
+    std::vector<uint16_t> next;
+    std::vector<CellT> out(static_cast<size_t>(w) * h);
+
+    for (int64_t step : steps_) {
+      if (step < first || step > last)
+        continue;
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        size_t pos;
+        if (!find(chunks[i], step, pos))
+          return false;
+        const ArchiveEntry &e = by_chunk[chunks[i]][pos];
+        if (!e.keyframe && decoded[i] != SIZE_MAX && decoded[i] + 1 == pos) {
+          next.resize(q[i].size());
+          if (!load(e, q[i].data(), next))
+            return false;
+          q[i].swap(next);
+        } else if (!decode_at(chunks[i], pos, q[i])) {
+          return false;
+        }
+        decoded[i] = pos;
+        blit(chunks[i], q[i], x0, y0, w, h, out);
+      }
+      fn(step, static_cast<const std::vector<CellT> &>(out));
+    }
+    return true;
+  }
+
+private:
+  bool corrupt_index(const std::string &path) {
+    std::cerr << "Corrupt archive index: " << path << std::endl;
+    file.close();
+    by_chunk.clear();
+    steps_.clear();
+    return false;
+  }
+
+  bool read_at(uint64_t offset, uint8_t *buf, size_t n) {
+    file.clear();
+    file.seekg(offset);
+    file.read(reinterpret_cast<char *>(buf), n);
+    return static_cast<size_t>(file.gcount()) == n;
+  }
+
+  bool valid_region(int x0, int y0, int w, int h) const {
+    return file.is_open() && !by_chunk.empty() && x0 >= 0 && y0 >= 0 &&
+           x0 < layout.width && y0 < layout.height && w > 0 && h > 0 &&
+           w <= layout.width - x0 && h <= layout.height - y0;
+  }
+
+  std::vector<int> chunks_in(int x0, int y0, int w, int h) const {
+    std::vector<int> chunks;
+    int cs = layout.chunk_size;
+    for (int cy = y0 / cs; cy <= (y0 + h - 1) / cs; ++cy)
+      for (int cx = x0 / cs; cx <= (x0 + w - 1) / cs; ++cx)
+        chunks.push_back(cy * layout.chunks_x() + cx);
+    return chunks;
+  }
+
+  bool find(int chunk, int64_t step, size_t &pos) const {
+    const auto &entries = by_chunk[chunk];
+    auto it = std::lower_bound(
+        entries.begin(), entries.end(), step,
+        [](const ArchiveEntry &e, int64_t s) { return e.step < s; });
+    if (it == entries.end() || it->step != step)
+      return false;
+    pos = it - entries.begin();
+    return true;
+  }
+
+  bool load(const ArchiveEntry &e, const uint16_t *base,
+            std::vector<uint16_t> &q) {
+    // Tiles live between the header and the index
+    if (e.offset < ARCHIVE_HEADER_SIZE || e.offset > index_offset ||
+        e.size > index_offset - e.offset)
+      return false;
+    std::vector<uint8_t> blob(e.size);
+    return read_at(e.offset, blob.data(), blob.size()) &&
+           archive_decode_tile(blob, base, q);
+  }
+
+  // Decodes the tile at pos by replaying deltas from the last keyframe
+  bool decode_at(int chunk, size_t pos, std::vector<uint16_t> &q) {
+    const auto &entries = by_chunk[chunk];
+    size_t key = pos;
+    while (key > 0 && !entries[key].keyframe)
+      --key;
+    if (!entries[key].keyframe)
+      return false;
+    int x0, y0, w, h;
+    layout.chunk_rect(chunk, x0, y0, w, h);
+    q.resize(2 * static_cast<size_t>(w) * h);
+    if (!load(entries[key], nullptr, q))
+      return false;
+    std::vector<uint16_t> next(q.size());
+    for (size_t i = key + 1; i <= pos; ++i) {
+      if (!load(entries[i], q.data(), next))
+        return false;
+      q.swap(next);
+    }
+    return true;
+  }
+
+  template <typename CellT>
+  void blit(int chunk, const std::vector<uint16_t> &q, int x0, int y0, int w,
+            int h, std::vector<CellT> &out) const {
+    int cx0, cy0, cw, ch;
+    layout.chunk_rect(chunk, cx0, cy0, cw, ch);
+    size_t n = static_cast<size_t>(cw) * ch;
+    for (int y = std::max(y0, cy0); y < std::min(y0 + h, cy0 + ch); ++y) {
+      for (int x = std::max(x0, cx0); x < std::min(x0 + w, cx0 + cw); ++x) {
+        size_t i = (y - cy0) * cw + (x - cx0);
+        CellT &c = out[(y - y0) * w + (x - x0)];
+        c.a = archive_dequantize(q[i]);
+        c.b = archive_dequantize(q[n + i]);
+      }
+    }
+  }
+
+  std::ifstream file;
+  ArchiveLayout layout{0, 0, 1};
+  int interval = 0;
+  uint64_t index_offset = 0;
+  std::vector<std::vector<ArchiveEntry>> by_chunk;
+  std::vector<int64_t> steps_;
+};
@@ -0,0 +1,225 @@
+#include "archive.hpp"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Round trip through ArchiveWriter and ArchiveReader. The field does not
+ * divide evenly into tiles, several workers write, and keyframes are close
+ * together so reads replay deltas across keyframe boundaries. Damaged
+ * copies of the archive and invalid writer parameters must be rejected.
+ *
+ * Exits non-zero if any check fails.
+ */
+
+struct Cell {
+  double a;
+  double b;
+};
+
+const int WIDTH = 200;
+const int HEIGHT = 150;
+const int STEP_INTERVAL = 5;
+const int CHUNK_SIZE = 64;
+const int KEYFRAME_INTERVAL = 4;
+const int STEPS = 200;
+// Half a quantization step, plus rounding slack
+const double MAX_ERROR = 0.5 / 65535.0 + 1e-12;
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+  std::cout << (ok ? "PASS " : "FAIL ") << what << std::endl;
+  failures += !ok;
+}
+
+double max_error(const std::vector<Cell> &want, int x0, int y0, int w, int h,
+                 const std::vector<Cell> &got) {
+  double err = 0;
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      const Cell &c = want[(y0 + y) * WIDTH + x0 + x];
+      const Cell &o = got[y * w + x];
+      err = std::max({err, std::abs(c.a - o.a), std::abs(c.b - o.b)});
+    }
+  }
+  return err;
+}
+
+std::vector<uint8_t> read_file(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), {}};
+}
+
+void set_u32(std::vector<uint8_t> &bytes, size_t pos, uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    bytes[pos + i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void set_u64(std::vector<uint8_t> &bytes, size_t pos, uint64_t v) {
+  for (int i = 0; i < 8; ++i)
+    bytes[pos + i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+// Writes bytes to path and reads the whole field at step 0 from it
+bool reads_back(const std::string &path, const std::vector<uint8_t> &bytes) {
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  }
+  ArchiveReader reader;
+  std::vector<Cell> out;
+  return reader.open(path) && reader.read_region(0, 0, 0, WIDTH, HEIGHT, out);
+}
+
+int main() {
+  std::string path =
+      (std::filesystem::temp_directory_path() / "archive_test.rda").string();
+
+  // Sparse random changes per step, like brush strokes on a settled field
+  std::vector<Cell> arr(WIDTH * HEIGHT, Cell{1.0, 0.0});
+  std::vector<std::vector<Cell>> history;
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<> dist(0.0, 1.0);
+  {
+    ArchiveWriter<Cell> writer(path, WIDTH, HEIGHT, STEP_INTERVAL, CHUNK_SIZE,
+                               KEYFRAME_INTERVAL, 3, 2);
+    check(writer.is_open(), "writer opens " + path);
+    for (int step = 0; step < STEPS; ++step) {
+      for (int i = 0; i < 50; ++i) {
+        Cell &c = arr[gen() % arr.size()];
+        c.a = dist(gen);
+        c.b = dist(gen);
+      }
+      if (step % STEP_INTERVAL == 0)
+        history.push_back(arr);
+      writer.submit(step, arr);
+    }
+    check(writer.finish(), "writer finishes");
+  }
+
+  ArchiveReader reader;
+  check(reader.open(path), "reader opens");
+  check(reader.width() == WIDTH && reader.height() == HEIGHT &&
+            reader.step_interval() == STEP_INTERVAL,
+        "header round trips");
+  check(reader.steps().size() == history.size(), "every stored step indexed");
+
+  double full_err = 0;
+  for (size_t k = 0; k < history.size(); ++k) {
+    std::vector<Cell> out;
+    if (!reader.read_region(k * STEP_INTERVAL, 0, 0, WIDTH, HEIGHT, out)) {
+      full_err = INFINITY;
+      break;
+    }
+    full_err =
+        std::max(full_err, max_error(history[k], 0, 0, WIDTH, HEIGHT, out));
+  }
+  check(full_err <= MAX_ERROR, "full field within quantization bound");
+
+  // Crosses tile borders and covers the clipped tiles on the right and
+  // bottom edge
+  const int x0 = 50, y0 = 60, w = WIDTH - 50, h = HEIGHT - 60;
+  std::vector<Cell> out;
+  check(reader.read_region(35, x0, y0, w, h, out) &&
+            max_error(history[35 / STEP_INTERVAL], x0, y0, w, h, out) <=
+                MAX_ERROR,
+        "edge region within quantization bound");
+
+  bool same = true;
+  int streamed = 0;
+  bool streamed_ok = reader.stream_region<Cell>(
+      x0, y0, w, h, 12, 180, [&](int64_t step, const std::vector<Cell> &got) {
+        std::vector<Cell> want;
+        same &= reader.read_region(step, x0, y0, w, h, want);
+        for (size_t i = 0; same && i < want.size(); ++i)
+          same &= want[i].a == got[i].a && want[i].b == got[i].b;
+        ++streamed;
+      });
+  check(streamed_ok && same && streamed == 34,
+        "stream_region matches read_region");
+
+  check(!reader.read_region(7, 0, 0, WIDTH, HEIGHT, out),
+        "step between intervals is missing");
+  check(!reader.read_region(STEPS, 0, 0, WIDTH, HEIGHT, out),
+        "step past the end is missing");
+  check(!reader.read_region(0, 1, 0, WIDTH, HEIGHT, out),
+        "region outside the field is rejected");
+
+  // Damaged copies of the archive must fail to open or read, not crash.
+  // The index is sorted, so its first entry is chunk 0 of step 0.
+  std::string bad_path =
+      (std::filesystem::temp_directory_path() / "archive_test_bad.rda")
+          .string();
+  const std::vector<uint8_t> good = read_file(path);
+  const size_t footer = good.size() - ARCHIVE_FOOTER_SIZE;
+  const uint64_t index_offset = archive_get_u64(good.data() + footer);
+  check(reads_back(bad_path, good), "untouched copy reads back");
+
+  std::vector<uint8_t> bad(good.begin(), good.end() - 10);
+  check(!reads_back(bad_path, bad), "truncated footer is rejected");
+  bad.assign(good.begin(), good.begin() + good.size() / 2);
+  check(!reads_back(bad_path, bad), "file cut in half is rejected");
+
+  bad = good;
+  bad[0] = 'X';
+  check(!reads_back(bad_path, bad), "bad header magic is rejected");
+  bad = good;
+  bad[footer + 16] = 'X';
+  check(!reads_back(bad_path, bad), "bad footer magic is rejected");
+
+  bad = good;
+  set_u32(bad, 8, ARCHIVE_MAX_SIDE + 1);
+  check(!reads_back(bad_path, bad), "oversized width is rejected");
+  bad = good;
+  set_u32(bad, 16, ARCHIVE_MAX_SIDE + 1);
+  check(!reads_back(bad_path, bad), "oversized chunk size is rejected");
+  bad = good;
+  set_u32(bad, 16, 0);
+  check(!reads_back(bad_path, bad), "zero chunk size is rejected");
+
+  bad = good;
+  set_u64(bad, footer + 8, uint64_t(1) << 62);
+  check(!reads_back(bad_path, bad), "oversized entry count is rejected");
+
+  bad = good;
+  set_u32(bad, index_offset + 8, 1000000);
+  check(!reads_back(bad_path, bad), "out-of-range chunk is rejected");
+
+  bad = good;
+  set_u64(bad, index_offset + 16, index_offset);
+  check(!reads_back(bad_path, bad), "tile offset into the index is rejected");
+  bad = good;
+  set_u32(bad, index_offset + 24, static_cast<uint32_t>(index_offset));
+  check(!reads_back(bad_path, bad), "tile size into the index is rejected");
+
+  // Would divide by zero or block forever in submit() if accepted
+  std::remove(bad_path.c_str());
+  const int bad_params[][5] = {
+      // step_interval chunk_size keyframe_interval max_pending width
+      {0, CHUNK_SIZE, KEYFRAME_INTERVAL, 2, WIDTH},
+      {STEP_INTERVAL, 0, KEYFRAME_INTERVAL, 2, WIDTH},
+      {STEP_INTERVAL, CHUNK_SIZE, 0, 2, WIDTH},
+      {STEP_INTERVAL, CHUNK_SIZE, KEYFRAME_INTERVAL, 0, WIDTH},
+      {STEP_INTERVAL, CHUNK_SIZE, KEYFRAME_INTERVAL, 2, -1},
+  };
+  bool rejected = true;
+  for (const auto &b : bad_params) {
+    ArchiveWriter<Cell> writer(bad_path, b[4], HEIGHT, b[0], b[1], b[2], 1,
+                               b[3]);
+    rejected &= !writer.is_open();
+    writer.submit(0, arr);
+    rejected &= !writer.finish();
+  }
+  check(rejected && !std::filesystem::exists(bad_path),
+        "writer rejects non-positive parameters");
+
+  std::remove(path.c_str());
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Structure to represent a cell
+struct Cell {
+  double a;
+  double b;
+};
+
+// Simulation parameters handed to every engine
+struct Params {
+  int width;
+  int height;
+  double diffusion_a;
+  double diffusion_b;
+  double feed;
+  double kill;
+  double dt;
+};
+
+inline int get_idx_from_xy(const Params &p, int x, int y) {
+  // Clamp x and y to valid ranges to prevent out-of-bounds access
+  x = std::max(0, std::min(p.width - 1, x));
+  y = std::max(0, std::min(p.height - 1, y));
+  return y * p.width + x;
+}
+
+// Function to initialize the arr with random values drawn from seed
+inline std::vector<Cell> initializearr(const Params &p, unsigned seed) {
+  std::vector<Cell> arr(p.width * p.height);
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<> dist(0.0, 1.0);
+
+  for (int y = 0; y < p.height; ++y) {
+    for (int x = 0; x < p.width; ++x) {
+      int idx = y * p.width + x;
+      arr[idx].a = 1.0;
+      arr[idx].b = 0.0;
+
+      // Add a small "seed" of B in the center for interesting patterns
+      if (x > p.width / 2 - 20 && x < p.width / 2 + 20 &&
+          y > p.height / 2 - 20 && y < p.height / 2 + 20) {
+        arr[idx].b = 1.0;
+      } else {
+        arr[idx].b = dist(gen);
+      }
+    }
+  }
+  return arr;
+}
+
+inline double laplaceA(const Params &p, int x, int y,
+                       const std::vector<Cell> &arr) {
+  // x and y should be in valid ranges [1, WIDTH-2] and [1, HEIGHT-2]
+  // for all the neighboring cells to be valid.
+  // get_idx_from_xy will handle the boundary checking
+  double sum = 0;
+  sum += arr[get_idx_from_xy(p, x, y)].a * -1;
+  sum += arr[get_idx_from_xy(p, x - 1, y)].a * 0.2;
+  sum += arr[get_idx_from_xy(p, x + 1, y)].a * 0.2;
+  sum += arr[get_idx_from_xy(p, x, y + 1)].a * 0.2;
+  sum += arr[get_idx_from_xy(p, x, y - 1)].a * 0.2;
+  sum += arr[get_idx_from_xy(p, x - 1, y - 1)].a * 0.05;
+  sum += arr[get_idx_from_xy(p, x + 1, y - 1)].a * 0.05;
+  sum += arr[get_idx_from_xy(p, x + 1, y + 1)].a * 0.05;
+  sum += arr[get_idx_from_xy(p, x - 1, y + 1)].a * 0.05;
+  return sum;
+}
+
+inline double laplaceB(const Params &p, int x, int y,
+                       const std::vector<Cell> &arr) {
+  // x and y should be in valid ranges [1, WIDTH-2] and [1, HEIGHT-2]
+  // for all the neighboring cells to be valid.
+  // get_idx_from_xy will handle the boundary checking
+  double sum = 0;
+  sum += arr[get_idx_from_xy(p, x, y)].b * -1;
+  sum += arr[get_idx_from_xy(p, x - 1, y)].b * 0.2;
+  sum += arr[get_idx_from_xy(p, x + 1, y)].b * 0.2;
+  sum += arr[get_idx_from_xy(p, x, y + 1)].b * 0.2;
+  sum += arr[get_idx_from_xy(p, x, y - 1)].b * 0.2;
+  sum += arr[get_idx_from_xy(p, x - 1, y - 1)].b * 0.05;
+  sum += arr[get_idx_from_xy(p, x + 1, y - 1)].b * 0.05;
+  sum += arr[get_idx_from_xy(p, x + 1, y + 1)].b * 0.05;
+  sum += arr[get_idx_from_xy(p, x - 1, y + 1)].b * 0.05;
+  return sum;
+}
+
+/*
+ * Reference semantics: nonparallel.cpp's serial updatearr, term for term.
+ * Each term is scaled by dt on its own, so with dt == 1 this is bitwise
+ * the nonparallel.cpp update. Engines are checked against this.
+ */
+inline void updatearr_reference(std::vector<Cell> &arr,
+                                std::vector<Cell> &nextarr, const Params &p) {
+  for (int y = 1; y < p.height - 1; ++y) {
+    for (int x = 1; x < p.width - 1; ++x) {
+      int idx = get_idx_from_xy(p, x, y);
+      double a = arr[idx].a;
+      double b = arr[idx].b;
+
+      double laplacianA = laplaceA(p, x, y, arr);
+      double laplacianB = laplaceB(p, x, y, arr);
+
+      nextarr[idx].a = a + p.dt * (p.diffusion_a * laplacianA) -
+                       p.dt * (a * b * b) + p.dt * (p.feed * (1 - a));
+      nextarr[idx].b = b + p.dt * (p.diffusion_b * laplacianB) +
+                       p.dt * (a * b * b) - p.dt * ((p.kill + p.feed) * b);
+
+      nextarr[idx].a = std::max(0.0, std::min(1.0, nextarr[idx].a));
+      nextarr[idx].b = std::max(0.0, std::min(1.0, nextarr[idx].b));
+    }
+  }
+  arr.swap(nextarr);
+}
+
+inline void updatearr_chunk(std::vector<Cell> &arr, std::vector<Cell> &nextarr,
+                            const Params &p, int start_y, int end_y) {
+  for (int y = start_y; y < end_y; ++y) {
+    for (int x = 1; x < p.width - 1; ++x) {
+      int idx = get_idx_from_xy(p, x, y);
+      double a = arr[idx].a;
+      double b = arr[idx].b;
+
+      double laplacianA = laplaceA(p, x, y, arr);
+      double laplacianB = laplaceB(p, x, y, arr);
+
+      nextarr[idx].a = a + ((p.diffusion_a * laplacianA) - (a * b * b) +
+                            (p.feed * (1 - a))) *
+                               p.dt;
+      nextarr[idx].b = b + ((p.diffusion_b * laplacianB) + (a * b * b) -
+                            ((p.kill + p.feed) * b)) *
+                               p.dt;
+
+      nextarr[idx].a = std::max(0.0, std::min(1.0, nextarr[idx].a));
+      nextarr[idx].b = std::max(0.0, std::min(1.0, nextarr[idx].b));
+    }
+  }
+}
+
+inline void updatearr_serial(std::vector<Cell> &arr, std::vector<Cell> &nextarr,
+                             const Params &p) {
+  updatearr_chunk(arr, nextarr, p, 1, p.height - 1);
+  arr.swap(nextarr);
+}
+
+inline void updatearr_parallel(std::vector<Cell> &arr,
+                               std::vector<Cell> &nextarr, const Params &p) {
+  int num_threads = std::max(1u, std::thread::hardware_concurrency());
+  int chunk_height = p.height / num_threads;
+  std::vector<std::future<void>> futures;
+
+  for (int i = 0; i < num_threads; ++i) {
+    int start_y = i * chunk_height + 1; // Start from 1 to avoid boundary issues
+    int end_y =
+        (i == num_threads - 1)
+            ? p.height - 1
+            : (start_y +
+               chunk_height); // End before HEIGHT to avoid boundary issues
+
+    futures.push_back(std::async(std::launch::async, updatearr_chunk,
+                                 std::ref(arr), std::ref(nextarr), std::cref(p),
+                                 start_y, end_y));
+  }
+
+  for (auto &future : futures) {
+    future.get();
+  }
+  arr.swap(nextarr);
+}
+
+// Every stepping engine the regression gate runs against the reference.
+// New engines get added here.
+struct Engine {
+  const char *name;
+  void (*step)(std::vector<Cell> &, std::vector<Cell> &, const Params &);
+};
+
+inline const std::vector<Engine> &engines() {
+  static const std::vector<Engine> all = {
+      {"serial", updatearr_serial},
+      {"parallel", updatearr_parallel},
+  };
+  return all;
+}
@@ -0,0 +1,379 @@
+#include "diffusion.hpp"
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Correctness and performance-regression gate for the stepping engines.
+ *
+ * The reference is nonparallel.cpp's updatearr. Each engine in engines()
+ * is checked against it for every dt in the run:
+ *
+ *   kernel    every step of the reference trajectory, the engine takes
+ *             one step from the same field as the reference and the two
+ *             results are compared cell by cell (ULP distance, with an
+ *             absolute tolerance for values near zero)
+ *   patterns  the engine runs on its own from the same seeded field for
+ *             all steps and its final pattern statistics are compared
+ *             with the reference's
+ *   speed     after a warmup, the run above is repeated and the fastest
+ *             repetition is compared against a stored baseline
+ *
+ * The model is chaotic, so rounding differences between engines grow
+ * over a long run. That is why cells are only compared one step at a
+ * time and the long run is judged by its statistics.
+ *
+ * Exits non-zero if any engine fails.
+ */
+
+struct Options {
+  // Rates match parallel.cpp; the field is not square so swapped x/y
+  // or width/height show up
+  Params params{320, 192, 0.2097, 0.1050, 0.0460, 0.0594, 1.0};
+  // nonparallel.cpp's implicit dt and parallel.cpp's DT
+  std::vector<double> dts = {1.0, 4.0};
+  int steps = 500;
+  unsigned seed = 42;
+  int64_t max_ulps = 16;
+  double tolerance = 1e-15;
+  double stat_tolerance = 1e-3;
+  double max_slowdown = 10.0;
+  int repeats = 5;
+  int warmup_steps = 50;
+  std::string baseline = "regression_baseline.txt";
+  bool update_baseline = false;
+};
+
+struct Stats {
+  double mean_a;
+  double mean_b;
+  double stddev_b;
+  double coverage; // fraction of cells with b > 0.25
+  double gradient; // mean |b(x+1) - b(x)| + |b(y+1) - b(y)|
+};
+
+Stats pattern_stats(const Params &p, const std::vector<Cell> &arr) {
+  Stats s{};
+  double n = arr.size();
+  for (const Cell &c : arr) {
+    s.mean_a += c.a;
+    s.mean_b += c.b;
+    s.coverage += c.b > 0.25;
+  }
+  s.mean_a /= n;
+  s.mean_b /= n;
+  s.coverage /= n;
+  for (const Cell &c : arr)
+    s.stddev_b += (c.b - s.mean_b) * (c.b - s.mean_b);
+  s.stddev_b = std::sqrt(s.stddev_b / n);
+  for (int y = 0; y < p.height - 1; ++y) {
+    for (int x = 0; x < p.width - 1; ++x) {
+      double b = arr[y * p.width + x].b;
+      s.gradient += std::abs(arr[y * p.width + x + 1].b - b) +
+                    std::abs(arr[(y + 1) * p.width + x].b - b);
+    }
+  }
+  s.gradient /= n;
+  return s;
+}
+
+// Distance in representable doubles between x and y
+int64_t ulp_distance(double x, double y) {
+  auto ordered = [](double v) {
+    int64_t i = std::bit_cast<int64_t>(v);
+    return i < 0 ? INT64_MIN - i : i;
+  };
+  int64_t a = ordered(x);
+  int64_t b = ordered(y);
+  return a > b ? a - b : b - a;
+}
+
+struct Result {
+  int64_t max_ulps = 0;
+  double max_abs = 0;
+  long bad_cells = 0;
+};
+
+// Folds the differences between ref and got into r
+void compare(const Options &o, const std::vector<Cell> &ref,
+             const std::vector<Cell> &got, Result &r) {
+  for (size_t i = 0; i < ref.size(); ++i) {
+    const double want[] = {ref[i].a, ref[i].b};
+    const double have[] = {got[i].a, got[i].b};
+    bool bad = false;
+    for (int k = 0; k < 2; ++k) {
+      int64_t ulps = ulp_distance(want[k], have[k]);
+      double diff = std::abs(want[k] - have[k]);
+      r.max_ulps = std::max(r.max_ulps, ulps);
+      r.max_abs = std::max(r.max_abs, diff);
+      bad |= ulps > o.max_ulps && diff > o.tolerance;
+    }
+    r.bad_cells += bad;
+  }
+}
+
+using Step = void (*)(std::vector<Cell> &, std::vector<Cell> &,
+                      const Params &);
+
+double run(const Params &p, int steps, Step step, std::vector<Cell> &arr) {
+  std::vector<Cell> nextarr = arr;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < steps; ++i)
+    step(arr, nextarr, p);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return steps / elapsed.count();
+}
+
+// Load on the machine only ever slows a run down, so the fastest of
+// several repetitions after a warmup is the steadiest measure. Every
+// repetition starts from the seed and leaves its final field in arr.
+double throughput(const Options &o, const Params &p, Step step,
+                  std::vector<Cell> &arr) {
+  arr = initializearr(p, o.seed);
+  run(p, o.warmup_steps, step, arr);
+  double best = 0;
+  for (int i = 0; i < o.repeats; ++i) {
+    arr = initializearr(p, o.seed);
+    best = std::max(best, run(p, o.steps, step, arr));
+  }
+  return best;
+}
+
+// Shortest text that reads back as exactly dt, so 4 and 4.0000001 get
+// different baseline lines
+std::string format_dt(double dt) {
+  char buf[32];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), dt);
+  return std::string(buf, end);
+}
+
+// Baseline lines are "<engine> <width>x<height> <dt> <steps per second>"
+std::string baseline_key(const Params &p, const std::string &engine) {
+  return engine + " " + std::to_string(p.width) + "x" +
+         std::to_string(p.height) + " " + format_dt(p.dt);
+}
+
+std::map<std::string, double> load_baseline(const std::string &path) {
+  std::map<std::string, double> baseline;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string engine, size;
+    double dt, sps;
+    if (fields >> engine >> size >> dt >> sps)
+      baseline[engine + " " + size + " " + format_dt(dt)] = sps;
+  }
+  return baseline;
+}
+
+bool save_baseline(const std::string &path,
+                   const std::map<std::string, double> &baseline) {
+  std::ofstream out(path);
+  for (const auto &[key, sps] : baseline)
+    out << key << " " << sps << "\n";
+  return static_cast<bool>(out);
+}
+
+void usage(const char *name) {
+  std::cerr
+      << "usage: " << name << " [options]\n"
+      << "  --width N           field width (default 320)\n"
+      << "  --height N          field height (default 192)\n"
+      << "  --steps N           steps per engine (default 500)\n"
+      << "  --seed N            seed of the initial field (default 42)\n"
+      << "  --dt X              time step, may be repeated (default 1 and 4)\n"
+      << "  --ulps N            max ULP distance of one step per value "
+         "(default 16)\n"
+      << "  --tolerance X       max absolute error of one step for values "
+         "beyond --ulps (default 1e-15)\n"
+      << "  --stat-tolerance X  max error of pattern statistics "
+         "(default 1e-3)\n"
+      << "  --max-slowdown PCT  allowed throughput drop below baseline "
+         "(default 10)\n"
+      << "                      on an idle machine the best of 5 runs "
+         "varies by about 1%;\n"
+      << "                      a busy machine can halve it, so run the "
+         "gate without other load\n"
+      << "  --repeats N         timed runs per engine, the fastest counts "
+         "(default 5)\n"
+      << "  --baseline FILE     throughput baseline "
+         "(default regression_baseline.txt)\n"
+      << "  --update-baseline   store this run's throughput as the "
+         "baseline\n";
+}
+
+bool parse(int argc, char *argv[], Options &o) {
+  bool default_dts = true;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--update-baseline") {
+      o.update_baseline = true;
+      continue;
+    }
+    if (i + 1 >= argc)
+      return false;
+    const char *value = argv[++i];
+    if (arg == "--width") {
+      o.params.width = std::atoi(value);
+    } else if (arg == "--height") {
+      o.params.height = std::atoi(value);
+    } else if (arg == "--steps") {
+      o.steps = std::atoi(value);
+    } else if (arg == "--seed") {
+      o.seed = std::strtoul(value, nullptr, 10);
+    } else if (arg == "--dt") {
+      if (default_dts)
+        o.dts.clear();
+      default_dts = false;
+      o.dts.push_back(std::atof(value));
+    } else if (arg == "--ulps") {
+      o.max_ulps = std::atoll(value);
+    } else if (arg == "--tolerance") {
+      o.tolerance = std::atof(value);
+    } else if (arg == "--stat-tolerance") {
+      o.stat_tolerance = std::atof(value);
+    } else if (arg == "--max-slowdown") {
+      o.max_slowdown = std::atof(value);
+    } else if (arg == "--repeats") {
+      o.repeats = std::atoi(value);
+    } else if (arg == "--baseline") {
+      o.baseline = value;
+    } else {
+      return false;
+    }
+  }
+  return o.params.width >= 3 && o.params.height >= 3 && o.steps > 0 &&
+         o.repeats > 0;
+}
+
+// Walks the reference trajectory and has every engine take each step from
+// the same field. Border cells are never written, so one scratch field
+// copied from the start serves every step.
+std::vector<Result> check_kernels(const Options &o, const Params &p,
+                                  std::vector<Cell> &ref) {
+  std::vector<Result> results(engines().size());
+  std::vector<Cell> prev = ref;
+  std::vector<Cell> got, scratch = ref;
+  for (int i = 0; i < o.steps; ++i) {
+    // Swaps, so prev holds the field the step started from
+    updatearr_reference(ref, prev, p);
+    for (size_t e = 0; e < engines().size(); ++e) {
+      got = prev;
+      engines()[e].step(got, scratch, p);
+      compare(o, ref, got, results[e]);
+    }
+  }
+  return results;
+}
+
+bool check_stats(const Options &o, const Stats &ref, const Stats &s) {
+  const std::pair<const char *, double> stat_diffs[] = {
+      {"mean a", s.mean_a - ref.mean_a},
+      {"mean b", s.mean_b - ref.mean_b},
+      {"stddev b", s.stddev_b - ref.stddev_b},
+      {"coverage", s.coverage - ref.coverage},
+      {"gradient", s.gradient - ref.gradient},
+  };
+  bool ok = true;
+  double worst = 0;
+  for (const auto &[name, diff] : stat_diffs) {
+    worst = std::max(worst, std::abs(diff));
+    if (std::abs(diff) > o.stat_tolerance) {
+      std::cout << "  " << name << " differs by " << diff << std::endl;
+      ok = false;
+    }
+  }
+  std::cout << "  patterns: max statistic error " << worst << std::endl;
+  return ok;
+}
+
+bool check_speed(const Options &o, const std::string &key, double sps,
+                 const std::map<std::string, double> &baseline) {
+  bool ok = true;
+  std::cout << "  throughput: " << sps << " steps/s";
+  auto it = baseline.find(key);
+  if (it != baseline.end()) {
+    double change = (sps / it->second - 1) * 100;
+    std::cout << " (" << (change >= 0 ? "+" : "") << change
+              << "% vs baseline " << it->second << ")";
+    if (!o.update_baseline && change < -o.max_slowdown) {
+      std::cout << "\n  slower than baseline by more than " << o.max_slowdown
+                << "%";
+      ok = false;
+    }
+  } else {
+    std::cout << " (no baseline)";
+  }
+  std::cout << std::endl;
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  Options o;
+  if (!parse(argc, argv, o)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::map<std::string, double> baseline = load_baseline(o.baseline);
+  bool ok = true;
+  for (double dt : o.dts) {
+    Params p = o.params;
+    p.dt = dt;
+    std::cout << "SIZE: " << p.width << "x" << p.height
+              << " STEPS: " << o.steps << " SEED: " << o.seed
+              << " DT: " << format_dt(dt) << std::endl;
+
+    std::vector<Cell> ref = initializearr(p, o.seed);
+    std::vector<Result> kernels = check_kernels(o, p, ref);
+    Stats ref_stats = pattern_stats(p, ref);
+
+    for (size_t e = 0; e < engines().size(); ++e) {
+      const Engine &engine = engines()[e];
+      const Result &r = kernels[e];
+      std::cout << "\n" << engine.name << ":" << std::endl;
+      std::cout << "  kernel: max ulps " << r.max_ulps << " max abs "
+                << r.max_abs << " cells out of tolerance " << r.bad_cells
+                << std::endl;
+      bool engine_ok = r.bad_cells == 0;
+
+      std::vector<Cell> arr;
+      double sps = throughput(o, p, engine.step, arr);
+      engine_ok &= check_stats(o, ref_stats, pattern_stats(p, arr));
+      std::string key = baseline_key(p, engine.name);
+      engine_ok &= check_speed(o, key, sps, baseline);
+      // A wrong engine must never become the speed to beat
+      if (o.update_baseline && engine_ok)
+        baseline[key] = sps;
+
+      std::cout << "  " << (engine_ok ? "PASS" : "FAIL") << std::endl;
+      ok &= engine_ok;
+    }
+    std::cout << std::endl;
+  }
+
+  if (o.update_baseline) {
+    if (!ok) {
+      std::cerr << "Not writing baseline " << o.baseline
+                << ": an engine failed" << std::endl;
+      return 1;
+    }
+    if (!save_baseline(o.baseline, baseline)) {
+      std::cerr << "Failed to write baseline " << o.baseline << std::endl;
+      return 1;
+    }
+    std::cout << "baseline written to " << o.baseline << std::endl;
+  }
+  return ok ? 0 : 1;
+}